@@ -0,0 +1,83 @@
+#ifndef CLKIN_MONITOR_H
+#define CLKIN_MONITOR_H
+#include <pico/stdlib.h>
+#include <hardware/gpio.h>
+#include <hardware/sync.h>
+#include <config.h>
+#include <harp_core.h>
+#include <harp_synchronizer.h>
+
+/**
+ * \brief Lock quality of the upstream Harp time on HARP_CLKIN_PIN.
+ */
+enum clkin_quality_t : uint8_t
+{
+    CLKIN_NO_SIGNAL = 0, // No valid frames recently.
+    CLKIN_POOR = 1,
+    CLKIN_FAIR = 2,
+    CLKIN_GOOD = 3
+};
+
+/**
+ * \brief Running stats (Welford's algorithm) over the whole monitoring run.
+ */
+struct clkin_running_stats_t
+{
+    uint32_t count;
+    float mean;
+    float m2;
+    float max_abs;
+};
+
+struct clkin_stats_t
+{
+    // Arrival time error (in us) of each frame vs. the expected whole-second
+    // cadence, in local system time. The mean is the upstream frequency
+    // offset (in us/s); the stddev is the jitter.
+    clkin_running_stats_t arrival_error_us;
+    // Correction (in us) applied to local Harp time after each frame.
+    clkin_running_stats_t correction_us;
+    uint32_t malformed_frames;
+    uint32_t late_frames; // Missing, extra, or off-cadence frames.
+    clkin_quality_t quality;
+};
+
+// Latest (possibly partial) frame. Written inside the GPIO interrupt.
+extern volatile uint32_t clkin_frame_first_edge_us;
+extern volatile uint32_t clkin_frame_last_edge_us;
+extern volatile uint32_t clkin_frame_edge_count;
+
+/**
+ * \brief Start timestamping the falling edges of incoming sync frames.
+ * \note The CLKIN pin stays in UART mode for the synchronizer. GPIO
+ *  interrupts see its input regardless of the selected pin function.
+ */
+void setup_clkin_monitor();
+
+/**
+ * \brief Timestamp a falling edge on HARP_CLKIN_PIN and group it into a
+ *  frame.
+ * \warning called inside of an interrupt.
+ */
+void clkin_edge_callback();
+
+/**
+ * \brief Process any completed frame and update the stats and quality.
+ *  Called in a loop in the Harp App.
+ * \return true if the stats (or lock quality) changed.
+ */
+bool update_clkin_monitor();
+
+/**
+ * \brief Clear all stats.
+ */
+void reset_clkin_monitor();
+
+const clkin_stats_t& clkin_stats();
+
+/**
+ * \brief get the standard deviation from running stats.
+ */
+float clkin_stddev(const clkin_running_stats_t& stats);
+
+#endif // CLKIN_MONITOR_H
@@ -29,7 +29,61 @@
                                           // (5[bytes]*100[kbps]) to make the
                                           // above statement meet the spec.
 
+// Extended (non-standard) CLKOUT frames for in-house receivers. These frames
+// are interleaved between the standard once-per-second frames and encode the
+// seconds *and* the sub-second time (in 32[us] ticks, like the Harp message
+// timestamp) at the falling edge of the first start bit.
+#define HARP_CLKOUT_EXT_HEADER_BYTE (0xAE) // Replaces 0xAF in the std header.
+#define HARP_CLKOUT_EXT_MSG_SIZE (8)
+#define MAX_EXT_CLKOUT_FREQUENCY_HZ (100)
+#define HARP_CLKOUT_EXT_BURST_COUNT (4) // Frames sent on a connect edge.
+#define HARP_CLKOUT_EXT_BURST_INTERVAL_US (1000) // > 8[bytes]*100[us/byte].
+#define HARP_CLKOUT_EXT_MIN_LEAD_US (20) // Min time to (re)arm the alarm.
+#define HARP_CLKOUT_BYTE_US (10'000'000UL / HARP_SYNC_BAUDRATE) // 8N1.
+#define HARP_CLKOUT_MSG_SIZE (6) // Standard frame.
+#define HARP_CLKOUT_EXT_GAP_US (200) // Min idle line around a standard frame.
+// Extended frames may not start inside this window before the whole second,
+// or they would collide with the standard frame (which starts at
+// HARP_SYNC_START_OFFSET_US) on the shared UART.
+#define HARP_CLKOUT_EXT_KEEPOUT_US (-HARP_SYNC_START_OFFSET_US \
+                                    + HARP_CLKOUT_EXT_MSG_SIZE*HARP_CLKOUT_BYTE_US \
+                                    + HARP_CLKOUT_EXT_GAP_US)
+// Bursts may resume this long after the standard frame starts.
+#define HARP_CLKOUT_EXT_RESUME_US (HARP_CLKOUT_MSG_SIZE*HARP_CLKOUT_BYTE_US \
+                                   + HARP_CLKOUT_EXT_GAP_US)
+#if HARP_CLKOUT_EXT_RESUME_US >= -HARP_SYNC_START_OFFSET_US
+#error "Extended CLKOUT bursts must resume before the whole second."
+#endif
+
+// Upstream CLKIN monitoring. Frames are delimited by gaps between falling
+// edges. Spans are from the first to the last falling edge of a frame.
+#define CLKIN_FRAME_GAP_US (150)
+// Start bits within a frame are at most one byte apart. Between an upstream
+// White Rabbit's frames, the line idles for the gap between them plus the
+// last byte's stop bit (and its last data bit, if high).
+#if (CLKIN_FRAME_GAP_US <= HARP_CLKOUT_BYTE_US) \
+    || (CLKIN_FRAME_GAP_US >= HARP_CLKOUT_EXT_GAP_US + HARP_CLKOUT_BYTE_US/5) \
+    || (CLKIN_FRAME_GAP_US >= HARP_CLKOUT_EXT_BURST_INTERVAL_US \
+                              - HARP_CLKOUT_EXT_MSG_SIZE*HARP_CLKOUT_BYTE_US \
+                              + HARP_CLKOUT_BYTE_US/5)
+#error "CLKIN_FRAME_GAP_US cannot split upstream frames."
+#endif
+#define CLKIN_FRAME_MIN_SPAN_US (480) // 6-byte frame: last byte starts at 500us.
+#define CLKIN_FRAME_MAX_SPAN_US (640)
+#define CLKIN_EXT_FRAME_MAX_SPAN_US (860) // 8-byte extended frames are ignored.
+#define CLKIN_MAX_ARRIVAL_ERROR_US (1000) // Frames beyond this are late.
+#define CLKIN_SIGNAL_TIMEOUT_US (2'500'000)
+#define CLKIN_QUALITY_FILTER_WEIGHT (0.125f) // Weight of the newest frame.
+#define CLKIN_GOOD_ERROR_US (5.0f) // Filtered jitter/correction thresholds.
+#define CLKIN_FAIR_ERROR_US (50.0f)
+// Rejected frames within the last 16 frames. One glitch can reject up to two
+// frames (the glitch and the next, now off-cadence, frame).
+#define CLKIN_FAIR_REJECTIONS (3)
+#define CLKIN_POOR_REJECTIONS (6)
+
 #define MAX_EVENT_FREQUENCY_HZ (1000)
+#define EVENT_QUEUE_DEPTH (32) // Per priority class.
+#define MAX_EVENT_PAYLOAD_SIZE (4) // Largest event register (U32).
 
 #define AUX_SYNC_UART (uart0)
 #define AUX_SYNC_DEFAULT_BAUDRATE (1000UL)
@@ -0,0 +1,86 @@
+#ifndef EVENT_QUEUE_H
+#define EVENT_QUEUE_H
+#include <pico/stdlib.h>
+#include <config.h>
+#include <harp_message.h>
+#include <harp_core.h>
+#include <tusb.h>
+
+/**
+ * \brief Outgoing event priority classes, dispatched in this order.
+ */
+enum event_priority_t : uint8_t
+{
+    HIGH_PRIORITY = 0, // Timing-critical events (i.e: Counter).
+    LOW_PRIORITY = 1, // State-change events (i.e: ConnectedDevices).
+    PRIORITY_LEVELS = 2
+};
+
+/**
+ * \brief Bounded, prioritized queue for outgoing Harp EVENT msgs.
+ * \details Register contents and the Harp timestamp are captured when the
+ *  event is queued, so a delayed event still reports the value and time at
+ *  which it happened. Events are only handed to USB when there is room to
+ *  send the whole msg, so a stalled host fills the queue (and counts drops)
+ *  instead of blocking the app loop.
+ */
+class EventQueue
+{
+public:
+    EventQueue();
+
+    /**
+     * \brief Queue an EVENT msg from the specified register.
+     * \param coalesce if true and an event from the same register is already
+     *  queued, replace its contents (and timestamp) instead of queuing another.
+     * \return false if the event was dropped because the queue was full.
+     */
+    bool push(event_priority_t priority, uint8_t address,
+              const volatile uint8_t* data, uint8_t num_bytes,
+              reg_type_t payload_type, bool coalesce = false);
+
+    /**
+     * \brief Send queued events, highest priority first, for as long as USB
+     *  has room for them.
+     */
+    void dispatch();
+
+    /**
+     * \brief Drop all queued events without counting them as drops.
+     */
+    void clear();
+
+    uint16_t high_water_mark() const {return high_water_mark_;}
+    uint32_t drop_count() const {return drop_count_;}
+    uint32_t max_latency_us() const {return max_latency_us_;}
+
+    void reset_high_water_mark() {high_water_mark_ = size_;}
+    void reset_drop_count() {drop_count_ = 0;}
+    void reset_max_latency_us() {max_latency_us_ = 0;}
+
+private:
+    struct event_t
+    {
+        uint64_t harp_time_us; // Timestamp sent with the event.
+        uint64_t queued_time_us; // System time. Immune to Harp time updates.
+        uint8_t address;
+        uint8_t num_bytes;
+        reg_type_t payload_type;
+        uint8_t payload[MAX_EVENT_PAYLOAD_SIZE];
+    };
+
+    struct ring_t
+    {
+        event_t events[EVENT_QUEUE_DEPTH];
+        uint8_t head; // Oldest event.
+        uint8_t count;
+    };
+
+    ring_t rings_[PRIORITY_LEVELS];
+    uint16_t size_; // Total events queued.
+    uint16_t high_water_mark_;
+    uint32_t drop_count_;
+    uint32_t max_latency_us_;
+};
+
+#endif // EVENT_QUEUE_H
@@ -12,6 +12,10 @@
 #include <uart_nonblocking.h>
 #include <soft_uart.h>
 #include <core_registers.h>
+#include <event_queue.h>
+#include <clkin_monitor.h>
+#include <hardware/dma.h>
+#include <hardware/uart.h>
 #include <pico/divider.h> // for fast hardware division.
 #ifdef DEBUG
     #include <stdio.h>
@@ -31,13 +35,16 @@ extern const uint8_t fw_version_minor;
 extern const uint16_t serial_number;
 
 // Setup for Harp App
-const size_t REG_COUNT{5};
+const size_t REG_COUNT{13};
 
 // pre-computed value for when to emit periodic counter msgs.
 extern uint32_t counter_interval_us;
 extern uint64_t last_msg_emit_time_us;
 extern bool was_synced;
 
+// Outgoing app events.
+extern EventQueue event_queue;
+
 #pragma pack(push, 1)
 struct app_regs_t
 {
@@ -57,6 +64,26 @@ struct app_regs_t
                                 //       encoded in the msg.
                                 // 2 --> output PPS signal.
     uint32_t AuxBaudRate;   // Set baud rate (in bps) for auxiliary UART.
+    uint16_t ExtClkoutFrequencyHz; // 0 --> disabled (spec-compliant CLKOUT).
+                                   // Otherwise, rate (in Hz) at which extended
+                                   // CLKOUT frames (seconds + sub-second) are
+                                   // interleaved with the standard frame.
+    uint16_t EventQueueHighWaterMark; // Most events queued at once.
+    uint32_t EventQueueDropCount; // Events dropped because the queue was full.
+    uint32_t EventQueueMaxLatencyUs; // Longest time an event spent queued.
+    // Writing any value to an EventQueue register resets it.
+    float ClkinArrivalErrorUs[3]; // Upstream sync frame arrival time error vs.
+                                  // the whole-second cadence (in local time):
+                                  // [mean, stddev, max magnitude].
+    float ClkinCorrectionUs[3]; // Correction applied to Harp time per frame:
+                                // [mean, stddev, max magnitude].
+    uint32_t ClkinRejectedFrames[2]; // [malformed, late].
+    uint8_t ClkinLockQuality; // 0 --> no signal.
+                              // 1 --> poor.
+                              // 2 --> fair.
+                              // 3 --> good.
+                              // An event is emitted when this changes.
+    // Writing any value to a Clkin register resets all Clkin stats.
     // More app "registers" here.
 };
 #pragma pack(pop)
@@ -82,6 +109,17 @@ extern volatile uint8_t harp_time_msg_b[6];
 extern volatile uint8_t *dispatch_buffer;
 extern volatile uint8_t *load_buffer;
 
+// Extended Harp CLKout Setup. Shares the DMA channel and UART with the
+// standard Harp CLKout.
+extern int32_t harp_clkout_ext_alarm_num;
+extern uint32_t harp_clkout_ext_irq_number;
+extern uint32_t harp_clkout_ext_interval_us;
+extern volatile uint8_t harp_clkout_ext_burst_remaining;
+
+// Single buffer for the extended msg. It is filled right before dispatch, and
+// dispatches are spaced further apart than the msg transmission time.
+extern volatile uint8_t harp_time_ext_msg[HARP_CLKOUT_EXT_MSG_SIZE];
+
 // AUX CLKout Double Buffer Setup
 extern volatile int aux_clkout_dma_chan;
 
@@ -112,6 +150,32 @@ void setup_harp_clkout();
  */
 void dispatch_and_reschedule_harp_clkout();
 
+/**
+ * \brief Setup periodic extended Harp Clkout dispatch at the rate specified
+ *  in the app registers.
+ */
+void setup_harp_clkout_ext();
+
+/*
+ * \brief Dispatch an extended time message (seconds + sub-second) to all 16
+ *  output channels and reschedule the next dispatch, avoiding the window
+ *  occupied by the standard Harp Clkout message and the whole second.
+ *  If a message is still being sent, retry once it completes instead.
+ * \warning called inside of an interrupt.
+ */
+void dispatch_and_reschedule_harp_clkout_ext();
+
+/*
+ * \brief Dispatch a burst of extended time messages as soon as possible.
+ *  Used to let newly-connected receivers lock quickly.
+ */
+void trigger_harp_clkout_ext_burst();
+
+/*
+ * \brief unclaim resources to produce the extended Harp Clkout signal.
+ */
+void cleanup_harp_clkout_ext();
+
 /**
  * \brief Setup AuxFn behavior where we dispatch the current time once per
  *  second at the start of the whole second at a baud rate specified in the app
@@ -159,6 +223,23 @@ void write_aux_port_fn(msg_t& msg);
 
 void write_aux_baud_rate(msg_t& msg);
 
+void write_ext_clkout_frequency_hz(msg_t& msg);
+
+void write_event_queue_stat(msg_t& msg);
+
+void write_clkin_stats(msg_t& msg);
+
+/**
+ * \brief copy the upstream CLKIN stats into the app registers.
+ */
+void update_clkin_regs();
+
+/**
+ * \brief emit periodic Counter events at the rate specified in the app
+ *  registers.
+ */
+void update_counter();
+
 /**
  * \brief update the app state. Called in a loop in the Harp App.
  */
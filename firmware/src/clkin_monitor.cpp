@@ -0,0 +1,227 @@
+#include <clkin_monitor.h>
+#include <cmath>
+#include <cstdlib>
+
+volatile uint32_t __not_in_flash("clkin_monitor") clkin_frame_first_edge_us;
+volatile uint32_t __not_in_flash("clkin_monitor") clkin_frame_last_edge_us;
+volatile uint32_t __not_in_flash("clkin_monitor") clkin_frame_edge_count = 0;
+
+static clkin_stats_t clkin_stats_;
+
+// Frame cadence state.
+static bool has_last_frame = false;
+static uint32_t last_frame_us; // First edge of the last standard frame.
+static bool has_last_offset = false;
+static int64_t last_offset_us; // Harp time - system time after the last frame.
+static bool has_quality_filter = false;
+static bool has_correction_filter = false;
+// Outcome of the most recent frames (newest in bit 0). 1 --> rejected.
+static uint16_t rejection_history = 0;
+// Filtered (EWMA) values for grading the lock quality so that the grade
+// follows the recent link behavior rather than the whole run.
+static float filtered_arrival_error_us;
+static float filtered_jitter_us;
+static float filtered_correction_us;
+static float filtered_correction_error_us;
+
+void setup_clkin_monitor()
+{
+    reset_clkin_monitor();
+    // Do not use the shared GPIO callback, which the app may not own.
+    gpio_add_raw_irq_handler(HARP_CLKIN_PIN, clkin_edge_callback);
+    gpio_set_irq_enabled(HARP_CLKIN_PIN, GPIO_IRQ_EDGE_FALL, true);
+    // Preempt the CLKOUT alarms and the synchronizer's UART RX, which fire
+    // during the upstream frame, so that they do not delay the timestamps.
+    // Note: this raises the priority of every GPIO interrupt.
+    irq_set_priority(IO_IRQ_BANK0, PICO_HIGHEST_IRQ_PRIORITY);
+    irq_set_enabled(IO_IRQ_BANK0, true);
+}
+
+void __not_in_flash_func(clkin_edge_callback)()
+{
+    if (!(gpio_get_irq_event_mask(HARP_CLKIN_PIN) & GPIO_IRQ_EDGE_FALL))
+        return;
+    gpio_acknowledge_irq(HARP_CLKIN_PIN, GPIO_IRQ_EDGE_FALL);
+    uint32_t curr_time_us = time_us_32();
+    // A long-enough gap since the last falling edge starts a new frame.
+    if ((clkin_frame_edge_count == 0)
+        || ((curr_time_us - clkin_frame_last_edge_us) > CLKIN_FRAME_GAP_US))
+    {
+        clkin_frame_first_edge_us = curr_time_us;
+        clkin_frame_edge_count = 0;
+    }
+    clkin_frame_last_edge_us = curr_time_us;
+    clkin_frame_edge_count += 1;
+}
+
+static void add_sample(clkin_running_stats_t& stats, float value)
+{
+    stats.count += 1;
+    float delta = value - stats.mean;
+    stats.mean += delta / stats.count;
+    stats.m2 += delta * (value - stats.mean);
+    if (fabsf(value) > stats.max_abs)
+        stats.max_abs = fabsf(value);
+}
+
+static void filter(float& filtered_value, float value)
+{
+    filtered_value += CLKIN_QUALITY_FILTER_WEIGHT * (value - filtered_value);
+}
+
+/**
+ * \brief Record whether the latest frame was rejected. Rejections grade the
+ *  lock by their rate over recent frames so a single glitch (i.e: plugging
+ *  in a cable) does not change the grade.
+ */
+static void record_frame(bool rejected)
+{
+    rejection_history = uint16_t((rejection_history << 1) | rejected);
+}
+
+static void update_quality()
+{
+    if (!has_last_frame || !has_quality_filter)
+    {
+        clkin_stats_.quality = CLKIN_NO_SIGNAL;
+        return;
+    }
+    float error_us = fmaxf(filtered_jitter_us, filtered_correction_error_us);
+    uint32_t rejections = __builtin_popcount(rejection_history);
+    if ((error_us > CLKIN_FAIR_ERROR_US)
+        || (rejections >= CLKIN_POOR_REJECTIONS))
+        clkin_stats_.quality = CLKIN_POOR;
+    else if ((error_us > CLKIN_GOOD_ERROR_US)
+             || (rejections >= CLKIN_FAIR_REJECTIONS))
+        clkin_stats_.quality = CLKIN_FAIR;
+    else
+        clkin_stats_.quality = CLKIN_GOOD;
+}
+
+static void process_clkin_frame(uint32_t first_edge_us, uint32_t span_us,
+                                uint32_t edge_count)
+{
+    // Every byte has a falling edge on its start bit.
+    if ((span_us < CLKIN_FRAME_MIN_SPAN_US) || (edge_count < 6)
+        || (span_us > CLKIN_EXT_FRAME_MAX_SPAN_US))
+    {
+        clkin_stats_.malformed_frames += 1;
+        record_frame(true);
+        return;
+    }
+    if (span_us > CLKIN_FRAME_MAX_SPAN_US)
+        return; // Extended frame from an upstream White Rabbit. Skip it.
+    // Compare the arrival time against the whole-second cadence.
+    if (has_last_frame)
+    {
+        int32_t arrival_error_us = int32_t(first_edge_us - last_frame_us)
+                                   - 1'000'000L;
+        if (abs(arrival_error_us) > CLKIN_MAX_ARRIVAL_ERROR_US)
+        {
+            clkin_stats_.late_frames += 1;
+            record_frame(true);
+        }
+        else
+        {
+            record_frame(false);
+            add_sample(clkin_stats_.arrival_error_us, float(arrival_error_us));
+            if (!has_quality_filter)
+            {
+                has_quality_filter = true;
+                filtered_arrival_error_us = float(arrival_error_us);
+                filtered_jitter_us = 0;
+            }
+            // The filtered mean absorbs the crystal frequency offset.
+            filter(filtered_arrival_error_us, float(arrival_error_us));
+            filter(filtered_jitter_us,
+                   fabsf(float(arrival_error_us) - filtered_arrival_error_us));
+        }
+    }
+    has_last_frame = true;
+    last_frame_us = first_edge_us;
+    // Measure the correction that the synchronizer applied for this frame.
+    if (!HarpSynchronizer::is_synced())
+        return;
+    uint64_t curr_system_time_us = time_us_64();
+    int64_t offset_us = int64_t(HarpCore::system_to_harp_us_64(curr_system_time_us)
+                                - curr_system_time_us);
+    if (has_last_offset)
+    {
+        float correction_us = float(offset_us - last_offset_us);
+        add_sample(clkin_stats_.correction_us, correction_us);
+        // Re-seed on the first correction after (re)locking, possibly to an
+        // upstream device with a different frequency offset.
+        if (!has_correction_filter)
+        {
+            has_correction_filter = true;
+            filtered_correction_us = correction_us;
+            filtered_correction_error_us = 0;
+        }
+        // Steady corrections only track the crystal frequency offset. Grade
+        // on steps away from that.
+        filter(filtered_correction_us, correction_us);
+        filter(filtered_correction_error_us,
+               fabsf(correction_us - filtered_correction_us));
+    }
+    has_last_offset = true;
+    last_offset_us = offset_us;
+}
+
+bool update_clkin_monitor()
+{
+    clkin_quality_t old_quality = clkin_stats_.quality;
+    bool updated = false;
+    // Grab the latest frame once it is complete.
+    uint32_t interrupt_status = save_and_disable_interrupts();
+    uint32_t curr_time_us = time_us_32();
+    uint32_t first_edge_us = clkin_frame_first_edge_us;
+    uint32_t last_edge_us = clkin_frame_last_edge_us;
+    uint32_t edge_count = clkin_frame_edge_count;
+    bool frame_complete = (edge_count > 0)
+        && ((curr_time_us - last_edge_us) > CLKIN_FRAME_GAP_US);
+    if (frame_complete)
+        clkin_frame_edge_count = 0;
+    restore_interrupts(interrupt_status);
+    if (frame_complete)
+    {
+        process_clkin_frame(first_edge_us, last_edge_us - first_edge_us,
+                            edge_count);
+        updated = true;
+    }
+    // Drop the lock if frames stop arriving.
+    if (has_last_frame
+        && ((curr_time_us - last_frame_us) > CLKIN_SIGNAL_TIMEOUT_US))
+    {
+        has_last_frame = false;
+        has_last_offset = false;
+        has_quality_filter = false;
+        has_correction_filter = false;
+        filtered_correction_error_us = 0;
+        rejection_history = 0;
+        updated = true;
+    }
+    update_quality();
+    return updated || (clkin_stats_.quality != old_quality);
+}
+
+void reset_clkin_monitor()
+{
+    clkin_stats_ = {};
+    clkin_stats_.quality = CLKIN_NO_SIGNAL;
+    has_last_frame = false;
+    has_last_offset = false;
+    has_quality_filter = false;
+    has_correction_filter = false;
+    filtered_correction_error_us = 0;
+    rejection_history = 0;
+}
+
+const clkin_stats_t& clkin_stats()
+{
+    return clkin_stats_;
+}
+
+float clkin_stddev(const clkin_running_stats_t& stats)
+{
+    return (stats.count > 1)? sqrtf(stats.m2 / (stats.count - 1)): 0.0f;
+}
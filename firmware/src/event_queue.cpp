@@ -0,0 +1,85 @@
+#include <event_queue.h>
+
+EventQueue::EventQueue()
+: size_{0}, high_water_mark_{0}, drop_count_{0}, max_latency_us_{0}
+{
+    clear();
+}
+
+bool EventQueue::push(event_priority_t priority, uint8_t address,
+                      const volatile uint8_t* data, uint8_t num_bytes,
+                      reg_type_t payload_type, bool coalesce)
+{
+    ring_t& ring = rings_[priority];
+    event_t* event = nullptr;
+    // Overwrite a queued event from the same register, if allowed.
+    if (coalesce)
+    {
+        for (uint8_t i = 0; i < ring.count; ++i)
+        {
+            event_t& queued = ring.events[(ring.head + i) % EVENT_QUEUE_DEPTH];
+            if (queued.address == address)
+            {
+                event = &queued;
+                break;
+            }
+        }
+    }
+    if (event == nullptr)
+    {
+        if (ring.count == EVENT_QUEUE_DEPTH)
+        {
+            drop_count_ += 1;
+            return false;
+        }
+        event = &ring.events[(ring.head + ring.count) % EVENT_QUEUE_DEPTH];
+        event->queued_time_us = time_us_64();
+        ring.count += 1;
+        size_ += 1;
+        if (size_ > high_water_mark_)
+            high_water_mark_ = size_;
+    }
+    event->harp_time_us = HarpCore::harp_time_us_64();
+    event->address = address;
+    event->num_bytes = (num_bytes > MAX_EVENT_PAYLOAD_SIZE)?
+                            MAX_EVENT_PAYLOAD_SIZE: num_bytes;
+    event->payload_type = payload_type;
+    for (uint8_t i = 0; i < event->num_bytes; ++i)
+        event->payload[i] = data[i];
+    return true;
+}
+
+void EventQueue::dispatch()
+{
+    for (uint8_t priority = 0; priority < PRIORITY_LEVELS; ++priority)
+    {
+        ring_t& ring = rings_[priority];
+        while (ring.count > 0)
+        {
+            event_t& event = ring.events[ring.head];
+            // Header (5) + timestamp (6) + payload + checksum (1).
+            if (tud_cdc_write_available() < (12u + event.num_bytes))
+                return; // Backpressure. Keep events queued until USB drains.
+            HarpCore::send_harp_reply(EVENT, event.address, event.payload,
+                                      event.num_bytes, event.payload_type,
+                                      event.harp_time_us);
+            uint64_t latency_us = time_us_64() - event.queued_time_us;
+            if (latency_us > max_latency_us_)
+                max_latency_us_ = (latency_us > UINT32_MAX)?
+                                    UINT32_MAX: uint32_t(latency_us);
+            ring.head = (ring.head + 1) % EVENT_QUEUE_DEPTH;
+            ring.count -= 1;
+            size_ -= 1;
+        }
+    }
+}
+
+void EventQueue::clear()
+{
+    for (uint8_t priority = 0; priority < PRIORITY_LEVELS; ++priority)
+    {
+        rings_[priority].head = 0;
+        rings_[priority].count = 0;
+    }
+    size_ = 0;
+}
@@ -27,6 +27,8 @@ int main()
     // to initialize the same hardware (HARP_UART) and skip if already
     // initialized.
     HarpSynchronizer& sync = HarpSynchronizer::init(HARP_UART, HARP_CLKIN_PIN);
+    // Timestamp incoming sync frames to grade the upstream link.
+    setup_clkin_monitor();
     // Create Harp App.
     HarpCApp& app = HarpCApp::init(HARP_DEVICE_ID,
                                    HW_VERSION_MAJOR, HW_VERSION_MINOR,
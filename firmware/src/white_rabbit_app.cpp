@@ -5,6 +5,8 @@ uint32_t counter_interval_us = 0;
 uint64_t last_msg_emit_time_us;
 bool was_synced = false;
 
+EventQueue event_queue;
+
 app_regs_t app_regs;
 
 // Harp CLKout Double Buffer Setup
@@ -21,6 +23,15 @@ volatile uint8_t __not_in_flash("double_buffers") harp_time_msg_b[6] =
 volatile uint8_t __not_in_flash("double_buffers") *dispatch_buffer;
 volatile uint8_t __not_in_flash("double_buffers") *load_buffer;
 
+// Extended Harp CLKout Setup
+int32_t __not_in_flash("double_buffers") harp_clkout_ext_alarm_num = -1;
+uint32_t __not_in_flash("double_buffers") harp_clkout_ext_irq_number;
+uint32_t __not_in_flash("double_buffers") harp_clkout_ext_interval_us;
+volatile uint8_t __not_in_flash("double_buffers") harp_clkout_ext_burst_remaining = 0;
+
+volatile uint8_t __not_in_flash("double_buffers") harp_time_ext_msg[HARP_CLKOUT_EXT_MSG_SIZE] =
+    {0xAA, HARP_CLKOUT_EXT_HEADER_BYTE, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
+
 // AUX CLKout Double Buffer Setup
 volatile int __not_in_flash("double_buffers") aux_clkout_dma_chan = -1;
 
@@ -137,6 +148,163 @@ void __not_in_flash_func(dispatch_and_reschedule_harp_clkout)()
     timer_hw->alarm[harp_clkout_alarm_num] = alarm_time_us;
 }
 
+void setup_harp_clkout_ext()
+{
+    // Extended msgs share the standard Harp CLKOUT DMA channel and UART, which
+    // are configured in setup_harp_clkout().
+    harp_clkout_ext_burst_remaining = 0;
+    harp_clkout_ext_interval_us =
+#if defined(PICO_RP2040)
+        div_u32u32(1'000'000UL, app_regs.ExtClkoutFrequencyHz);
+#else
+        1'000'000UL / app_regs.ExtClkoutFrequencyHz;
+#endif
+    // Leverage RP2040 ALARMs to dispatch periodically via interrupt handler.
+    // Tell Pico-SDK that we are using this alarm.
+    if (harp_clkout_ext_alarm_num < 0)
+        harp_clkout_ext_alarm_num = hardware_alarm_claim_unused(true);
+    // TODO: harp_clkout_ext_irq_number = TIMER_IRQ_NUM(timer_hw, harp_clkout_ext_alarm_num);
+    harp_clkout_ext_irq_number = TIMER_IRQ_0 + harp_clkout_ext_alarm_num;
+#if defined(DEBUG)
+    printf("harp clkout ext alarm num: %d | irq num: %d\r\n",
+           harp_clkout_ext_alarm_num, harp_clkout_ext_irq_number);
+#endif
+    // Attach interrupt to function and enable alarm to generate interrupt.
+    irq_set_exclusive_handler(harp_clkout_ext_irq_number,
+                              dispatch_and_reschedule_harp_clkout_ext);
+    irq_set_enabled(harp_clkout_ext_irq_number, true);
+    // Fire the first dispatch immediately. The handler schedules the rest.
+    irq_set_pending(harp_clkout_ext_irq_number);
+}
+
+void __not_in_flash_func(dispatch_and_reschedule_harp_clkout_ext)()
+{
+    // Clear the latched hardware interrupt (if latched).
+    timer_hw->intr = (1u << harp_clkout_ext_alarm_num);
+    // Do not reprogram the shared DMA channel while a msg is still going out
+    // (i.e: if a burst or a new rate interrupts a periodic msg). Retry once
+    // the remaining bytes (+1 in the UART shift register) have been sent.
+    if (dma_channel_is_busy(harp_clkout_dma_chan)
+        || (uart_get_hw(HARP_UART)->fr & UART_UARTFR_BUSY_BITS))
+    {
+        uint32_t remaining_bytes =
+            dma_hw->ch[harp_clkout_dma_chan].transfer_count + 1;
+        timer_hw->inte |= (1u << harp_clkout_ext_alarm_num);
+        timer_hw->alarm[harp_clkout_ext_alarm_num] =
+            time_us_32() + remaining_bytes * HARP_CLKOUT_BYTE_US
+            + HARP_CLKOUT_EXT_MIN_LEAD_US;
+        return;
+    }
+    // Split the current harp time into whole seconds and microseconds.
+    uint64_t curr_harp_time_us = HarpCore::harp_time_us_64();
+    uint32_t curr_harp_seconds =
+#if defined(PICO_RP2040)
+        uint32_t(div_u64u64(curr_harp_time_us, 1'000'000UL));
+#else
+        uint32_t(curr_harp_time_us / 1'000'000UL);
+#endif
+    uint32_t curr_us = uint32_t(curr_harp_time_us
+                                - uint64_t(curr_harp_seconds) * 1'000'000UL);
+    // Window around the standard msg that leads the next whole second (in us
+    // into the current second).
+    const uint32_t keepout_start_us = 1'000'000UL - HARP_CLKOUT_EXT_KEEPOUT_US;
+    const uint32_t resume_us = 1'000'000UL + HARP_SYNC_START_OFFSET_US
+                               + HARP_CLKOUT_EXT_RESUME_US;
+    // Dispatch the current time, but only if this msg cannot collide with the
+    // standard msg.
+    if ((curr_us < keepout_start_us) || (curr_us >= resume_us))
+    {
+        uint16_t curr_ticks = uint16_t(curr_us >> 5); // 32[us] ticks.
+        memcpy((void*)(harp_time_ext_msg + 2), (void*)(&curr_harp_seconds),
+               sizeof(curr_harp_seconds));
+        memcpy((void*)(harp_time_ext_msg + 6), (void*)(&curr_ticks),
+               sizeof(curr_ticks));
+        // Standard receivers share the output. Skip msgs whose contents would
+        // look like a standard 0xAA 0xAF header to them.
+        bool has_std_header = false;
+        for (uint8_t i = 2; i < HARP_CLKOUT_EXT_MSG_SIZE - 1; ++i)
+            has_std_header |= (harp_time_ext_msg[i] == 0xAA)
+                              && (harp_time_ext_msg[i + 1] == 0xAF);
+        if (!has_std_header)
+            dispatch_uart_stream(harp_clkout_dma_chan, HARP_UART,
+                                 (uint8_t*)harp_time_ext_msg,
+                                 HARP_CLKOUT_EXT_MSG_SIZE);
+        if (harp_clkout_ext_burst_remaining > 0)
+            harp_clkout_ext_burst_remaining -= 1;
+    }
+    // Compute the next dispatch time (in us into the current second).
+    // Bursts are spaced back-to-back. Otherwise, use the next slot. Slots are
+    // offset by half an interval so that none lands on the whole second,
+    // where the PPS and AUX CLKout alarms fire.
+    uint32_t slot_phase_us = harp_clkout_ext_interval_us / 2;
+    uint32_t next_us;
+    if (harp_clkout_ext_burst_remaining > 0)
+        next_us = curr_us + HARP_CLKOUT_EXT_BURST_INTERVAL_US;
+    else if (curr_us + HARP_CLKOUT_EXT_MIN_LEAD_US < slot_phase_us)
+        next_us = slot_phase_us;
+    else
+        next_us =
+#if defined(PICO_RP2040)
+            (div_u32u32(curr_us + HARP_CLKOUT_EXT_MIN_LEAD_US - slot_phase_us,
+                        harp_clkout_ext_interval_us) + 1)
+            * harp_clkout_ext_interval_us + slot_phase_us;
+#else
+            ((curr_us + HARP_CLKOUT_EXT_MIN_LEAD_US - slot_phase_us)
+             / harp_clkout_ext_interval_us + 1) * harp_clkout_ext_interval_us
+            + slot_phase_us;
+#endif
+    // Resume bursts right after the standard msg so that a newly-connected
+    // receiver does not wait for the next slot. Defer periodic msgs that land
+    // in the keepout window to the first slot of the next second.
+    if (harp_clkout_ext_burst_remaining > 0)
+    {
+        if ((next_us >= keepout_start_us) && (next_us < resume_us))
+            next_us = resume_us;
+    }
+    else if (next_us >= keepout_start_us)
+        next_us = 1'000'000UL + slot_phase_us;
+    uint64_t next_msg_harp_time_us = (uint64_t(curr_harp_seconds) * 1'000'000UL)
+                                     + next_us;
+    // Schedule next time msg dispatch in system time.
+    // Low-level interface (fast!) to re-schedule this function.
+    uint32_t alarm_time_us = HarpCore::harp_to_system_us_32(next_msg_harp_time_us);
+    // Enable alarm to trigger interrupt.
+    timer_hw->inte |= (1u << harp_clkout_ext_alarm_num);
+    // Arm alarm by writing the alarm time.
+    timer_hw->alarm[harp_clkout_ext_alarm_num] = alarm_time_us;
+}
+
+void trigger_harp_clkout_ext_burst()
+{
+    // Bail early if the extended Harp CLKOUT is not running.
+    if (harp_clkout_ext_alarm_num < 0)
+        return;
+    harp_clkout_ext_burst_remaining = HARP_CLKOUT_EXT_BURST_COUNT;
+    // Dispatch now. The handler will re-arm the alarm for the rest.
+    irq_set_pending(harp_clkout_ext_irq_number);
+}
+
+void cleanup_harp_clkout_ext()
+{
+    // Bail early if resources have not been allocated for this behavior.
+    if (harp_clkout_ext_alarm_num < 0)
+        return;
+    // Disarm alarm by writing 1 to the corresponding alarm.
+    timer_hw->armed = (1u << harp_clkout_ext_alarm_num);
+    // Clear the latched hardware interrupt (if latched).
+    timer_hw->intr = (1u << harp_clkout_ext_alarm_num);
+    // Disable alarm to trigger interrupt.
+    timer_hw->inte &= ~(1u << harp_clkout_ext_alarm_num);
+    // Unreserve Alarm and IRQ.
+    hardware_alarm_unclaim(harp_clkout_ext_alarm_num);
+    harp_clkout_ext_alarm_num = -1;
+    irq_set_enabled(harp_clkout_ext_irq_number, false);
+    irq_clear(harp_clkout_ext_irq_number);
+    irq_remove_handler(harp_clkout_ext_irq_number,
+                       dispatch_and_reschedule_harp_clkout_ext);
+    harp_clkout_ext_burst_remaining = 0;
+}
+
 void setup_aux_clkout()
 {
     // Setup DMA.
@@ -411,6 +579,69 @@ void write_aux_baud_rate(msg_t& msg)
         HarpCore::send_harp_reply(WRITE, msg.header.address);
 }
 
+void write_ext_clkout_frequency_hz(msg_t& msg)
+{
+    uint16_t old_frequency_hz = app_regs.ExtClkoutFrequencyHz;
+    HarpCore::copy_msg_payload_to_register(msg);
+    // Reject rates that cannot fit between standard msgs.
+    if (app_regs.ExtClkoutFrequencyHz > MAX_EXT_CLKOUT_FREQUENCY_HZ)
+    {
+        if (!HarpCore::is_muted())
+            HarpCore::send_harp_reply(WRITE_ERROR, msg.header.address);
+        app_regs.ExtClkoutFrequencyHz = old_frequency_hz; // Keep the old rate.
+        return;
+    }
+    cleanup_harp_clkout_ext(); // Always do this before reconfiguring.
+    if (app_regs.ExtClkoutFrequencyHz > 0)
+        setup_harp_clkout_ext();
+    if (!HarpCore::is_muted())
+        HarpCore::send_harp_reply(WRITE, msg.header.address);
+}
+
+void write_event_queue_stat(msg_t& msg)
+{
+    switch (msg.header.address)
+    {
+        case APP_REG_START_ADDRESS + 6:
+            event_queue.reset_high_water_mark();
+            break;
+        case APP_REG_START_ADDRESS + 7:
+            event_queue.reset_drop_count();
+            break;
+        case APP_REG_START_ADDRESS + 8:
+            event_queue.reset_max_latency_us();
+            break;
+    }
+    // Reply with the reset value.
+    app_regs.EventQueueHighWaterMark = event_queue.high_water_mark();
+    app_regs.EventQueueDropCount = event_queue.drop_count();
+    app_regs.EventQueueMaxLatencyUs = event_queue.max_latency_us();
+    if (!HarpCore::is_muted())
+        HarpCore::send_harp_reply(WRITE, msg.header.address);
+}
+
+void write_clkin_stats(msg_t& msg)
+{
+    reset_clkin_monitor();
+    update_clkin_regs(); // Reply with the reset values.
+    if (!HarpCore::is_muted())
+        HarpCore::send_harp_reply(WRITE, msg.header.address);
+}
+
+void update_clkin_regs()
+{
+    const clkin_stats_t& stats = clkin_stats();
+    app_regs.ClkinArrivalErrorUs[0] = stats.arrival_error_us.mean;
+    app_regs.ClkinArrivalErrorUs[1] = clkin_stddev(stats.arrival_error_us);
+    app_regs.ClkinArrivalErrorUs[2] = stats.arrival_error_us.max_abs;
+    app_regs.ClkinCorrectionUs[0] = stats.correction_us.mean;
+    app_regs.ClkinCorrectionUs[1] = clkin_stddev(stats.correction_us);
+    app_regs.ClkinCorrectionUs[2] = stats.correction_us.max_abs;
+    app_regs.ClkinRejectedFrames[0] = stats.malformed_frames;
+    app_regs.ClkinRejectedFrames[1] = stats.late_frames;
+    app_regs.ClkinLockQuality = stats.quality;
+}
+
 void update_app_state()
 {
     if (soft_uart.requires_update())
@@ -422,11 +653,38 @@ void update_app_state()
     port_raw >>= 8;
     port_raw = ((port_raw & 0x000000FF) << 8) | ((port_raw & 0x0000FF00) >> 8);
     app_regs.ConnectedDevices = uint16_t(port_raw);
-    // If port state changed, dispatch event from ConnectedDevices app reg (32).
+    // If port state changed, queue event from ConnectedDevices app reg (32).
+    // Only the latest state matters, so coalesce with any queued event.
     // TODO: add hysteresis.
     if ((old_port_raw != app_regs.ConnectedDevices) && !HarpCore::is_muted())
-        HarpCore::send_harp_reply(EVENT, APP_REG_START_ADDRESS);
+        event_queue.push(LOW_PRIORITY, APP_REG_START_ADDRESS,
+                         (uint8_t*)&app_regs.ConnectedDevices,
+                         sizeof(app_regs.ConnectedDevices), U16, true);
+    // Let newly-connected receivers lock quickly with extended msgs.
+    if (app_regs.ConnectedDevices & ~old_port_raw)
+        trigger_harp_clkout_ext_burst();
+    update_counter();
+    // Update upstream CLKIN stats, and issue an event from ClkinLockQuality
+    // app reg (44) if the lock quality changed. Every threshold crossing
+    // matters (i.e: a brief dip during a USB stall), so do not coalesce.
+    if (update_clkin_monitor())
+    {
+        uint8_t old_quality = app_regs.ClkinLockQuality;
+        update_clkin_regs();
+        if ((app_regs.ClkinLockQuality != old_quality) && !HarpCore::is_muted())
+            event_queue.push(LOW_PRIORITY, APP_REG_START_ADDRESS + 12,
+                             &app_regs.ClkinLockQuality,
+                             sizeof(app_regs.ClkinLockQuality), U8);
+    }
+    event_queue.dispatch();
+    // Publish queue stats.
+    app_regs.EventQueueHighWaterMark = event_queue.high_water_mark();
+    app_regs.EventQueueDropCount = event_queue.drop_count();
+    app_regs.EventQueueMaxLatencyUs = event_queue.max_latency_us();
+}
 
+void update_counter()
+{
     // Nothing to do if we're not instructed to emit periodic msgs.
     if (app_regs.CounterFrequencyHz == 0)
         return;
@@ -444,9 +702,12 @@ void update_app_state()
     {
         last_msg_emit_time_us += counter_interval_us;
         app_regs.Counter += 1;
-        // Issue EVENT from Counter register.
+        // Queue EVENT from Counter register. Every count matters, so do not
+        // coalesce.
         if (!HarpCore::is_muted())
-            HarpCore::send_harp_reply(EVENT, APP_REG_START_ADDRESS + 1);
+            event_queue.push(HIGH_PRIORITY, APP_REG_START_ADDRESS + 1,
+                             (uint8_t*)&app_regs.Counter,
+                             sizeof(app_regs.Counter), U32);
     }
 }
 
@@ -464,6 +725,14 @@ void reset_app()
     app_regs.Counter = 0;
     app_regs.CounterFrequencyHz = 0;
     setup_harp_clkout();
+    app_regs.ExtClkoutFrequencyHz = 0; // Start spec-compliant.
+    cleanup_harp_clkout_ext();
+    event_queue.clear();
+    event_queue.reset_high_water_mark();
+    event_queue.reset_drop_count();
+    event_queue.reset_max_latency_us();
+    reset_clkin_monitor();
+    update_clkin_regs();
 #if defined(DEBUG)
     app_regs.AuxPortFn = 0; // Start with AUX CLKout disabled.
 #else
@@ -484,6 +753,14 @@ RegSpecs app_reg_specs[REG_COUNT]
     {(uint8_t*)&app_regs.CounterFrequencyHz, sizeof(app_regs.CounterFrequencyHz), U16}, // 34
     {(uint8_t*)&app_regs.AuxPortFn, sizeof(app_regs.AuxPortFn), U8}, // 35
     {(uint8_t*)&app_regs.AuxBaudRate, sizeof(app_regs.AuxBaudRate), U32}, // 36
+    {(uint8_t*)&app_regs.ExtClkoutFrequencyHz, sizeof(app_regs.ExtClkoutFrequencyHz), U16}, // 37
+    {(uint8_t*)&app_regs.EventQueueHighWaterMark, sizeof(app_regs.EventQueueHighWaterMark), U16}, // 38
+    {(uint8_t*)&app_regs.EventQueueDropCount, sizeof(app_regs.EventQueueDropCount), U32}, // 39
+    {(uint8_t*)&app_regs.EventQueueMaxLatencyUs, sizeof(app_regs.EventQueueMaxLatencyUs), U32}, // 40
+    {(uint8_t*)&app_regs.ClkinArrivalErrorUs, sizeof(app_regs.ClkinArrivalErrorUs), Float}, // 41
+    {(uint8_t*)&app_regs.ClkinCorrectionUs, sizeof(app_regs.ClkinCorrectionUs), Float}, // 42
+    {(uint8_t*)&app_regs.ClkinRejectedFrames, sizeof(app_regs.ClkinRejectedFrames), U32}, // 43
+    {(uint8_t*)&app_regs.ClkinLockQuality, sizeof(app_regs.ClkinLockQuality), U8}, // 44
     // More specs here if we add additional registers.
 };
 
@@ -494,6 +771,14 @@ RegFnPair reg_handler_fns[REG_COUNT]
     {HarpCore::read_reg_generic, write_counter_frequency_hz},           // 34
     {HarpCore::read_reg_generic, write_aux_port_fn},                    // 35
     {HarpCore::read_reg_generic, write_aux_baud_rate},                  // 36
+    {HarpCore::read_reg_generic, write_ext_clkout_frequency_hz},        // 37
+    {HarpCore::read_reg_generic, write_event_queue_stat},               // 38
+    {HarpCore::read_reg_generic, write_event_queue_stat},               // 39
+    {HarpCore::read_reg_generic, write_event_queue_stat},               // 40
+    {HarpCore::read_reg_generic, write_clkin_stats},                    // 41
+    {HarpCore::read_reg_generic, write_clkin_stats},                    // 42
+    {HarpCore::read_reg_generic, write_clkin_stats},                    // 43
+    {HarpCore::read_reg_generic, write_clkin_stats},                    // 44
     // More handler function pairs here if we add additional registers.
 };
 
@@ -0,0 +1,59 @@
+#ifndef CAPTURE_READER_H
+#define CAPTURE_READER_H
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * \brief Receives the digital transitions of the selected channels, in time
+ *  order, from a capture reader.
+ */
+class EdgeSink
+{
+public:
+    virtual ~EdgeSink() = default;
+
+    /**
+     * \brief First known level of a channel. Not a transition.
+     */
+    virtual void on_initial_level(size_t channel, int64_t time_ps,
+                                  bool level) = 0;
+
+    virtual void on_edge(size_t channel, int64_t time_ps, bool level) = 0;
+};
+
+/**
+ * \brief Stream a logic-analyzer CSV export (i.e: Saleae Logic, sigrok) into
+ *  the sink. The first non-comment line is the header. Time is in seconds
+ *  unless the time column header specifies a unit ("[ms]", "[us]", "[ns]").
+ * \param channel_names column header (or zero-based column index) per sink
+ *  channel. Empty names are skipped.
+ * \param[out] end_ps time of the last row.
+ * \return false (with error set) if the capture could not be parsed.
+ */
+bool read_csv_capture(FILE* file, const std::vector<std::string>& channel_names,
+                      size_t time_column, EdgeSink& sink, int64_t& end_ps,
+                      std::string& error);
+
+/**
+ * \brief Stream a Value Change Dump (VCD) into the sink. Channels are matched
+ *  by signal reference name (i.e: "CLKOUT") or scoped name (i.e: "top.CLKOUT").
+ * \param channel_names signal name per sink channel. Empty names are skipped.
+ * \param[out] end_ps time of the last timestamp.
+ * \return false (with error set) if the capture could not be parsed.
+ */
+bool read_vcd_capture(FILE* file, const std::vector<std::string>& channel_names,
+                      EdgeSink& sink, int64_t& end_ps, std::string& error);
+
+/**
+ * \brief Parse a decimal number (optionally signed, with fraction and
+ *  exponent) scaled by 10^scale_exp10 into an integer without going through
+ *  floating point. i.e: ("1.5e-6", 12) --> 1'500'000.
+ * \return false if text is not a number.
+ */
+bool parse_scaled_decimal(std::string_view text, int scale_exp10,
+                          int64_t& value);
+
+#endif // CAPTURE_READER_H
@@ -0,0 +1,74 @@
+#ifndef LINE_READER_H
+#define LINE_READER_H
+#include <cstdio>
+#include <cstring>
+#include <string_view>
+#include <vector>
+
+/**
+ * \brief Chunked line reader for multi-GB text captures. Lines are returned
+ *  as views into an internal buffer and are valid until the next call.
+ */
+class LineReader
+{
+public:
+    explicit LineReader(FILE* file, size_t chunk_size = 4u << 20)
+    : file_{file}, buffer_(chunk_size)
+    {}
+
+    /**
+     * \brief Get the next line (without the line terminator).
+     * \return false at the end of the file.
+     */
+    bool next_line(std::string_view& line)
+    {
+        while (true)
+        {
+            const char* start = buffer_.data() + pos_;
+            const char* newline = (const char*)memchr(start, '\n', end_ - pos_);
+            if (newline != nullptr)
+            {
+                size_t len = newline - start;
+                pos_ += len + 1;
+                if (len > 0 && start[len - 1] == '\r')
+                    --len;
+                line = std::string_view(start, len);
+                return true;
+            }
+            if (eof_) // Last line without a terminator.
+            {
+                if (pos_ == end_)
+                    return false;
+                line = std::string_view(start, end_ - pos_);
+                pos_ = end_;
+                return true;
+            }
+            refill();
+        }
+    }
+
+private:
+    void refill()
+    {
+        // Move the partial line to the front and grow if a line is too long.
+        size_t remaining = end_ - pos_;
+        memmove(buffer_.data(), buffer_.data() + pos_, remaining);
+        pos_ = 0;
+        end_ = remaining;
+        if (end_ == buffer_.size())
+            buffer_.resize(buffer_.size() * 2);
+        size_t num_read = fread(buffer_.data() + end_, 1,
+                                buffer_.size() - end_, file_);
+        end_ += num_read;
+        if (num_read == 0)
+            eof_ = true;
+    }
+
+    FILE* file_;
+    std::vector<char> buffer_;
+    size_t pos_ = 0;
+    size_t end_ = 0;
+    bool eof_ = false;
+};
+
+#endif // LINE_READER_H
@@ -0,0 +1,41 @@
+#ifndef RUNNING_STATS_H
+#define RUNNING_STATS_H
+#include <cmath>
+#include <cstddef>
+#include <limits>
+
+/**
+ * \brief Streaming mean/stddev/min/max (Welford's algorithm) so that
+ *  arbitrarily long captures can be summarized in constant memory.
+ */
+class RunningStats
+{
+public:
+    void add(double x)
+    {
+        ++count_;
+        double delta = x - mean_;
+        mean_ += delta / count_;
+        m2_ += delta * (x - mean_);
+        if (x < min_)
+            min_ = x;
+        if (x > max_)
+            max_ = x;
+    }
+
+    size_t count() const {return count_;}
+    double mean() const {return mean_;}
+    double stddev() const
+    {return (count_ > 1)? std::sqrt(m2_ / (count_ - 1)): 0.0;}
+    double min() const {return min_;}
+    double max() const {return max_;}
+
+private:
+    size_t count_ = 0;
+    double mean_ = 0.0;
+    double m2_ = 0.0;
+    double min_ = std::numeric_limits<double>::infinity();
+    double max_ = -std::numeric_limits<double>::infinity();
+};
+
+#endif // RUNNING_STATS_H
@@ -0,0 +1,64 @@
+#ifndef UART_DECODER_H
+#define UART_DECODER_H
+#include <cstdint>
+#include <vector>
+
+struct UartByte
+{
+    int64_t start_ps; // Falling edge of the start bit.
+    uint8_t value;
+    bool framing_error; // Stop bit was sampled low.
+};
+
+/**
+ * \brief 8N1 UART decoder driven by line transitions (rather than samples).
+ *  Each bit is sampled at its center from the last known line level.
+ */
+class UartDecoder
+{
+public:
+    explicit UartDecoder(uint32_t baud_rate);
+
+    /**
+     * \brief Set the line level without treating it as a transition.
+     */
+    void set_initial_level(bool level);
+
+    /**
+     * \brief Apply a line transition. Bytes completed before this transition
+     *  are appended to bytes().
+     */
+    void on_edge(int64_t time_ps, bool level);
+
+    /**
+     * \brief Complete any byte whose sample points precede time_ps. Call this
+     *  as other channels advance so bytes are not held until the next edge.
+     */
+    void advance(int64_t time_ps) {sample_until(time_ps);}
+
+    /**
+     * \brief Complete any byte whose sample points precede end_ps and drop
+     *  any truncated byte.
+     */
+    void finish(int64_t end_ps);
+
+    /**
+     * \brief Bytes decoded so far. The caller drains (clears) this.
+     */
+    std::vector<UartByte>& bytes() {return bytes_;}
+
+    double bit_period_ps() const {return bit_period_ps_;}
+
+private:
+    void sample_until(int64_t time_ps);
+
+    double bit_period_ps_;
+    std::vector<UartByte> bytes_;
+    bool level_ = true; // UART idles high.
+    bool in_frame_ = false;
+    int64_t frame_start_ps_ = 0;
+    uint8_t next_bit_ = 0; // 0: start bit, 1-8: data bits, 9: stop bit.
+    uint8_t shift_reg_ = 0;
+};
+
+#endif // UART_DECODER_H
@@ -0,0 +1,143 @@
+#ifndef VERIFIER_H
+#define VERIFIER_H
+#include <capture_reader.h>
+#include <running_stats.h>
+#include <uart_decoder.h>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <string>
+#include <vector>
+
+// Per spec, the Harp time message is sent at 100 kbaud and the whole second
+// occurs 672 us after the start of the last byte.
+// https://harp-tech.org/protocol/SynchronizationClock.html
+constexpr uint32_t HARP_SYNC_BAUDRATE = 100'000;
+constexpr int64_t HARP_SYNC_LAST_BYTE_TO_SECOND_PS = 672'000'000;
+// Extended (0xAA 0xAE) CLKOUT msgs encode the sub-second in 32 us ticks, as
+// of the Harp msg timestamp.
+constexpr int64_t HARP_CLKOUT_EXT_TICK_PS = 32'000'000;
+
+constexpr int64_t PS_PER_US = 1'000'000;
+constexpr int64_t PS_PER_S = 1'000'000'000'000;
+
+/**
+ * \brief Sink channel slots.
+ */
+enum Channel : size_t
+{
+    CLKOUT = 0,
+    AUX = 1,
+    PPS = 2,
+    CHANNEL_COUNT = 3
+};
+
+struct VerifierConfig
+{
+    bool has_clkout = false;
+    bool has_aux = false;
+    bool has_pps = false;
+    uint32_t aux_baud_rate = 1000; // Device default.
+    double pps_limit_us = 1.0; // README: error from Harp time < 1 us.
+    double aux_limit_us = 3.0; // README: error from Harp time < 3 us.
+    double ext_limit_us = 3.0; // Beyond the 32 us tick quantization.
+    double period_tolerance_us = 100.0; // Absorbs analyzer clock error.
+    size_t max_listed_violations = 20;
+};
+
+/**
+ * \brief Decode the CLKOUT, AUX UART, and PPS lines of a capture and check
+ *  each decoded second against the edge timing.
+ * \details The nominal whole second is taken from the CLKOUT line (672 us
+ *  after the start of the last byte of the Harp time msg). AUX, PPS, and
+ *  extended CLKOUT msgs are measured against it.
+ */
+class Verifier : public EdgeSink
+{
+public:
+    explicit Verifier(const VerifierConfig& config);
+
+    void on_initial_level(size_t channel, int64_t time_ps,
+                          bool level) override;
+
+    void on_edge(size_t channel, int64_t time_ps, bool level) override;
+
+    /**
+     * \brief Process anything still buffered at the end of the capture.
+     */
+    void finish(int64_t end_ps);
+
+    void print_report(FILE* out) const;
+
+    size_t violation_count() const {return violation_count_;}
+
+private:
+    struct Second
+    {
+        uint32_t seconds;
+        int64_t time_ps; // Capture time of the whole second.
+    };
+
+    /**
+     * \brief Bring all decoders up to time_ps so that events are handled in
+     *  capture time order across channels.
+     */
+    void advance(int64_t time_ps);
+
+    void handle_clkout_byte(const UartByte& byte);
+    void handle_clkout_msg();
+    void handle_clkout_ext_msg();
+    void handle_aux_byte(const UartByte& byte);
+    void handle_aux_msg();
+    void handle_pps_edge(int64_t time_ps, bool level);
+
+    /**
+     * \brief Find the CLKOUT whole second nearest to time_ps (within half a
+     *  second).
+     * \return nullptr if there is none.
+     */
+    const Second* nearest_second(int64_t time_ps) const;
+    const Second* find_second(uint32_t seconds) const;
+
+    void add_violation(int64_t time_ps, const std::string& what);
+
+    VerifierConfig config_;
+    UartDecoder clkout_decoder_;
+    UartDecoder aux_decoder_;
+
+    // CLKOUT state.
+    std::vector<UartByte> clkout_bytes_; // Msg being assembled.
+    std::deque<Second> seconds_; // Most recent whole seconds.
+    size_t clkout_msgs_ = 0;
+    size_t clkout_ext_msgs_ = 0;
+    size_t clkout_framing_errors_ = 0;
+    RunningStats clkout_period_error_us_;
+    RunningStats clkout_ext_offset_us_;
+    size_t clkout_ext_unreferenced_ = 0;
+
+    // AUX state.
+    std::vector<UartByte> aux_bytes_;
+    int64_t last_aux_msg_ps_ = 0;
+    size_t aux_msgs_ = 0;
+    size_t aux_framing_errors_ = 0;
+    RunningStats aux_offset_us_;
+    RunningStats aux_period_error_us_;
+    size_t aux_unreferenced_ = 0;
+
+    // PPS state.
+    bool has_pps_rise_ = false; // Capture times may be negative.
+    int64_t last_pps_rise_ps_ = 0;
+    size_t pps_pulses_ = 0;
+    RunningStats pps_offset_us_;
+    RunningStats pps_period_error_us_;
+    RunningStats pps_high_time_error_us_;
+    size_t pps_unreferenced_ = 0;
+
+    int64_t start_ps_ = INT64_MAX;
+    int64_t end_ps_ = 0;
+    size_t edge_count_ = 0;
+    size_t violation_count_ = 0;
+    std::vector<std::string> violations_; // First few, for the report.
+};
+
+#endif // VERIFIER_H
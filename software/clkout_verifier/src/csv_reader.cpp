@@ -0,0 +1,233 @@
+#include <capture_reader.h>
+#include <line_reader.h>
+
+namespace
+{
+
+std::string_view trim(std::string_view text)
+{
+    while (!text.empty() && (text.front() == ' ' || text.front() == '\t'
+                             || text.front() == '"'))
+        text.remove_prefix(1);
+    while (!text.empty() && (text.back() == ' ' || text.back() == '\t'
+                             || text.back() == '"'))
+        text.remove_suffix(1);
+    return text;
+}
+
+/**
+ * \brief Split a line on commas into (reused) column views.
+ */
+void split_columns(std::string_view line, std::vector<std::string_view>& columns)
+{
+    columns.clear();
+    while (true)
+    {
+        size_t comma = line.find(',');
+        columns.push_back(trim(line.substr(0, comma)));
+        if (comma == std::string_view::npos)
+            return;
+        line.remove_prefix(comma + 1);
+    }
+}
+
+bool is_index(const std::string& name)
+{
+    if (name.empty())
+        return false;
+    for (char c: name)
+    {
+        if (c < '0' || c > '9')
+            return false;
+    }
+    return true;
+}
+
+/**
+ * \brief Power of ten to convert the time column to picoseconds.
+ */
+int time_scale_exp10(std::string_view header)
+{
+    if (header.find("[ms]") != std::string_view::npos)
+        return 9;
+    if (header.find("[us]") != std::string_view::npos)
+        return 6;
+    if (header.find("[ns]") != std::string_view::npos)
+        return 3;
+    return 12; // seconds.
+}
+
+} // namespace
+
+bool parse_scaled_decimal(std::string_view text, int scale_exp10,
+                          int64_t& value)
+{
+    size_t i = 0;
+    bool negative = false;
+    if (i < text.size() && (text[i] == '-' || text[i] == '+'))
+        negative = (text[i++] == '-');
+    // Accumulate up to 18 significant digits into the mantissa and track the
+    // decimal exponent of its last digit.
+    uint64_t mantissa = 0;
+    int num_digits = 0;
+    int exp10 = scale_exp10;
+    bool seen_point = false;
+    bool any_digits = false;
+    for (; i < text.size(); ++i)
+    {
+        char c = text[i];
+        if (c >= '0' && c <= '9')
+        {
+            any_digits = true;
+            if (num_digits < 18)
+            {
+                mantissa = mantissa * 10 + (c - '0');
+                if (mantissa != 0)
+                    ++num_digits;
+                if (seen_point)
+                    --exp10;
+            }
+            else if (!seen_point)
+                ++exp10; // Dropped integer digit.
+        }
+        else if (c == '.' && !seen_point)
+            seen_point = true;
+        else
+            break;
+    }
+    if (!any_digits)
+        return false;
+    if (i < text.size() && (text[i] == 'e' || text[i] == 'E'))
+    {
+        ++i;
+        bool exp_negative = false;
+        if (i < text.size() && (text[i] == '-' || text[i] == '+'))
+            exp_negative = (text[i++] == '-');
+        int exponent = 0;
+        bool any_exp_digits = false;
+        for (; i < text.size() && text[i] >= '0' && text[i] <= '9'; ++i)
+        {
+            any_exp_digits = true;
+            if (exponent < 1000)
+                exponent = exponent * 10 + (text[i] - '0');
+        }
+        if (!any_exp_digits)
+            return false;
+        exp10 += exp_negative? -exponent: exponent;
+    }
+    if (i != text.size())
+        return false;
+    // Apply the decimal exponent. Round when dropping digits.
+    for (; exp10 > 0; --exp10)
+    {
+        if (mantissa > uint64_t(INT64_MAX) / 10)
+            return false; // Overflow.
+        mantissa *= 10;
+    }
+    for (; exp10 < 0 && mantissa != 0; ++exp10)
+        mantissa = (exp10 == -1)? (mantissa + 5) / 10: mantissa / 10;
+    if (mantissa > uint64_t(INT64_MAX))
+        return false;
+    value = negative? -int64_t(mantissa): int64_t(mantissa);
+    return true;
+}
+
+bool read_csv_capture(FILE* file, const std::vector<std::string>& channel_names,
+                      size_t time_column, EdgeSink& sink, int64_t& end_ps,
+                      std::string& error)
+{
+    LineReader reader(file);
+    std::string_view line;
+    std::vector<std::string_view> columns;
+    // Find the header.
+    bool found_header = false;
+    while (reader.next_line(line))
+    {
+        if (line.empty() || line[0] == ';' || line[0] == '#')
+            continue;
+        found_header = true;
+        break;
+    }
+    if (!found_header)
+    {
+        error = "CSV capture has no header.";
+        return false;
+    }
+    split_columns(line, columns);
+    if (time_column >= columns.size())
+    {
+        error = "CSV time column is out of range.";
+        return false;
+    }
+    int scale_exp10 = time_scale_exp10(columns[time_column]);
+    // Map each requested channel to a column.
+    const size_t NO_COLUMN = size_t(-1);
+    std::vector<size_t> channel_columns(channel_names.size(), NO_COLUMN);
+    size_t max_column = time_column;
+    for (size_t ch = 0; ch < channel_names.size(); ++ch)
+    {
+        const std::string& name = channel_names[ch];
+        if (name.empty())
+            continue;
+        for (size_t col = 0; col < columns.size(); ++col)
+        {
+            if (columns[col] == name)
+                channel_columns[ch] = col;
+        }
+        if (channel_columns[ch] == NO_COLUMN && is_index(name)
+            && std::stoul(name) < columns.size())
+            channel_columns[ch] = std::stoul(name);
+        if (channel_columns[ch] == NO_COLUMN)
+        {
+            error = "CSV capture has no column named \"" + name + "\".";
+            return false;
+        }
+        if (channel_columns[ch] > max_column)
+            max_column = channel_columns[ch];
+    }
+    // Stream rows. Only level changes are forwarded, so both transition-only
+    // and per-sample exports work.
+    std::vector<int8_t> levels(channel_names.size(), -1); // -1: unknown.
+    size_t line_num = 1;
+    end_ps = 0;
+    while (reader.next_line(line))
+    {
+        ++line_num;
+        if (line.empty() || line[0] == ';' || line[0] == '#')
+            continue;
+        split_columns(line, columns);
+        if (columns.size() <= max_column)
+        {
+            error = "CSV line " + std::to_string(line_num) + " is truncated.";
+            return false;
+        }
+        int64_t time_ps;
+        if (!parse_scaled_decimal(columns[time_column], scale_exp10, time_ps))
+        {
+            error = "CSV line " + std::to_string(line_num) + " has a bad time.";
+            return false;
+        }
+        end_ps = time_ps;
+        for (size_t ch = 0; ch < channel_columns.size(); ++ch)
+        {
+            if (channel_columns[ch] == NO_COLUMN)
+                continue;
+            std::string_view value = columns[channel_columns[ch]];
+            if (value != "0" && value != "1")
+            {
+                error = "CSV line " + std::to_string(line_num)
+                        + " has a non-binary level.";
+                return false;
+            }
+            int8_t level = (value[0] == '1');
+            if (level == levels[ch])
+                continue;
+            if (levels[ch] < 0)
+                sink.on_initial_level(ch, time_ps, level);
+            else
+                sink.on_edge(ch, time_ps, level);
+            levels[ch] = level;
+        }
+    }
+    return true;
+}
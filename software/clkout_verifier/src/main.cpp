@@ -0,0 +1,136 @@
+#include <capture_reader.h>
+#include <verifier.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+void print_usage(const char* program)
+{
+    fprintf(stderr,
+        "Usage: %s [options] <capture.csv|capture.vcd|->\n"
+        "Verify captured CLKOUT, AUX UART, and PPS waveforms.\n"
+        "At least one of --clkout, --aux, or --pps is required.\n"
+        "\n"
+        "  --clkout <name>          CLKOUT channel (CSV column or VCD signal).\n"
+        "  --aux <name>             AUX UART channel.\n"
+        "  --pps <name>             PPS channel.\n"
+        "  --aux-baud <bps>         AUX UART baud rate (default: 1000).\n"
+        "  --format <csv|vcd>       Capture format (default: from extension).\n"
+        "  --time-col <index>       CSV time column (default: 0).\n"
+        "  --pps-limit-us <us>      Max PPS offset (default: 1).\n"
+        "  --aux-limit-us <us>      Max AUX UART offset (default: 3).\n"
+        "  --ext-limit-us <us>      Max extended CLKOUT offset beyond the\n"
+        "                           32 us tick (default: 3).\n"
+        "  --period-tolerance-us <us>\n"
+        "                           Max CLKOUT period error (default: 100).\n"
+        "  --max-listed <count>     Violations to list (default: 20).\n"
+        "\n"
+        "Exits with 0 if there are no violations, 1 if there are violations,\n"
+        "and 2 on error.\n", program);
+}
+
+bool ends_with(const std::string& text, const char* suffix)
+{
+    size_t len = strlen(suffix);
+    return text.size() >= len
+           && text.compare(text.size() - len, len, suffix) == 0;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    VerifierConfig config;
+    std::vector<std::string> channel_names(CHANNEL_COUNT);
+    std::string format;
+    std::string path;
+    size_t time_column = 0;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        bool has_value = (i + 1 < argc);
+        if (arg == "-h" || arg == "--help")
+        {
+            print_usage(argv[0]);
+            return 0;
+        }
+        else if (arg == "--clkout" && has_value)
+            channel_names[CLKOUT] = argv[++i];
+        else if (arg == "--aux" && has_value)
+            channel_names[AUX] = argv[++i];
+        else if (arg == "--pps" && has_value)
+            channel_names[PPS] = argv[++i];
+        else if (arg == "--aux-baud" && has_value)
+            config.aux_baud_rate = strtoul(argv[++i], nullptr, 10);
+        else if (arg == "--format" && has_value)
+            format = argv[++i];
+        else if (arg == "--time-col" && has_value)
+            time_column = strtoul(argv[++i], nullptr, 10);
+        else if (arg == "--pps-limit-us" && has_value)
+            config.pps_limit_us = strtod(argv[++i], nullptr);
+        else if (arg == "--aux-limit-us" && has_value)
+            config.aux_limit_us = strtod(argv[++i], nullptr);
+        else if (arg == "--ext-limit-us" && has_value)
+            config.ext_limit_us = strtod(argv[++i], nullptr);
+        else if (arg == "--period-tolerance-us" && has_value)
+            config.period_tolerance_us = strtod(argv[++i], nullptr);
+        else if (arg == "--max-listed" && has_value)
+            config.max_listed_violations = strtoul(argv[++i], nullptr, 10);
+        else if (path.empty() && (arg == "-" || arg[0] != '-'))
+            path = arg;
+        else
+        {
+            print_usage(argv[0]);
+            return 2;
+        }
+    }
+    config.has_clkout = !channel_names[CLKOUT].empty();
+    config.has_aux = !channel_names[AUX].empty();
+    config.has_pps = !channel_names[PPS].empty();
+    if (path.empty() || !(config.has_clkout || config.has_aux || config.has_pps))
+    {
+        print_usage(argv[0]);
+        return 2;
+    }
+    if (config.aux_baud_rate == 0)
+    {
+        fprintf(stderr, "Error: AUX baud rate must be nonzero.\n");
+        return 2;
+    }
+    if (format.empty())
+        format = (ends_with(path, ".vcd") || ends_with(path, ".VCD"))? "vcd": "csv";
+    if (format != "csv" && format != "vcd")
+    {
+        fprintf(stderr, "Error: unknown format \"%s\".\n", format.c_str());
+        return 2;
+    }
+    // Stream from stdin to allow i.e: zcat capture.csv.gz | clkout_verifier -
+    FILE* file = (path == "-")? stdin: fopen(path.c_str(), "rb");
+    if (file == nullptr)
+    {
+        fprintf(stderr, "Error: cannot open \"%s\".\n", path.c_str());
+        return 2;
+    }
+    Verifier verifier(config);
+    int64_t end_ps = 0;
+    std::string error;
+    bool ok = (format == "vcd")?
+        read_vcd_capture(file, channel_names, verifier, end_ps, error):
+        read_csv_capture(file, channel_names, time_column, verifier, end_ps,
+                         error);
+    if (file != stdin)
+        fclose(file);
+    if (!ok)
+    {
+        fprintf(stderr, "Error: %s\n", error.c_str());
+        return 2;
+    }
+    verifier.finish(end_ps);
+    verifier.print_report(stdout);
+    return (verifier.violation_count() == 0)? 0: 1;
+}
@@ -0,0 +1,60 @@
+#include <uart_decoder.h>
+
+UartDecoder::UartDecoder(uint32_t baud_rate)
+: bit_period_ps_{1e12 / baud_rate}
+{}
+
+void UartDecoder::set_initial_level(bool level)
+{
+    level_ = level;
+    in_frame_ = false;
+}
+
+void UartDecoder::sample_until(int64_t time_ps)
+{
+    while (in_frame_)
+    {
+        // Sample in the center of the bit.
+        int64_t sample_ps = frame_start_ps_
+            + int64_t((next_bit_ + 0.5) * bit_period_ps_);
+        if (sample_ps >= time_ps)
+            return;
+        if (next_bit_ == 0) // Start bit.
+        {
+            if (level_) // Glitch. Not a real start bit.
+            {
+                in_frame_ = false;
+                return;
+            }
+            shift_reg_ = 0;
+        }
+        else if (next_bit_ <= 8) // Data bits, LSb first.
+            shift_reg_ |= uint8_t(level_) << (next_bit_ - 1);
+        else // Stop bit.
+        {
+            bytes_.push_back({frame_start_ps_, shift_reg_, !level_});
+            in_frame_ = false;
+            return;
+        }
+        ++next_bit_;
+    }
+}
+
+void UartDecoder::on_edge(int64_t time_ps, bool level)
+{
+    sample_until(time_ps);
+    bool falling = level_ && !level;
+    level_ = level;
+    if (falling && !in_frame_)
+    {
+        in_frame_ = true;
+        frame_start_ps_ = time_ps;
+        next_bit_ = 0;
+    }
+}
+
+void UartDecoder::finish(int64_t end_ps)
+{
+    sample_until(end_ps);
+    in_frame_ = false; // Drop any truncated byte.
+}
@@ -0,0 +1,214 @@
+#include <capture_reader.h>
+#include <line_reader.h>
+#include <unordered_map>
+
+namespace
+{
+
+/**
+ * \brief Pop the next whitespace-delimited token from text.
+ */
+bool next_token(std::string_view& text, std::string_view& token)
+{
+    size_t start = text.find_first_not_of(" \t");
+    if (start == std::string_view::npos)
+    {
+        text = std::string_view();
+        return false;
+    }
+    size_t end = text.find_first_of(" \t", start);
+    if (end == std::string_view::npos)
+        end = text.size();
+    token = text.substr(start, end - start);
+    text.remove_prefix(end);
+    return true;
+}
+
+/**
+ * \brief Power of ten to convert a VCD timescale (i.e: "10ns") to picoseconds.
+ * \return false if the timescale is not recognized.
+ */
+bool timescale_exp10(std::string_view timescale, int& exp10)
+{
+    size_t unit_pos = timescale.find_first_not_of("0123456789");
+    if (unit_pos == 0 || unit_pos == std::string_view::npos)
+        return false;
+    std::string_view magnitude = timescale.substr(0, unit_pos);
+    std::string_view unit = timescale.substr(unit_pos);
+    if (magnitude == "1")
+        exp10 = 0;
+    else if (magnitude == "10")
+        exp10 = 1;
+    else if (magnitude == "100")
+        exp10 = 2;
+    else
+        return false;
+    if (unit == "s")
+        exp10 += 12;
+    else if (unit == "ms")
+        exp10 += 9;
+    else if (unit == "us")
+        exp10 += 6;
+    else if (unit == "ns")
+        exp10 += 3;
+    else if (unit == "ps")
+        exp10 += 0;
+    else if (unit == "fs")
+        exp10 -= 3;
+    else
+        return false;
+    return true;
+}
+
+} // namespace
+
+bool read_vcd_capture(FILE* file, const std::vector<std::string>& channel_names,
+                      EdgeSink& sink, int64_t& end_ps, std::string& error)
+{
+    LineReader reader(file);
+    std::string_view line;
+    std::string_view token;
+    // Parse the header (declarations) as a token stream since declarations
+    // may span lines.
+    int exp10 = 0; // 1ps if unspecified.
+    std::vector<std::string> scopes;
+    std::unordered_map<std::string, size_t> id_to_channel;
+    std::string keyword; // Current declaration.
+    std::vector<std::string> args;
+    bool in_header = true;
+    while (in_header && reader.next_line(line))
+    {
+        while (next_token(line, token))
+        {
+            if (keyword.empty())
+            {
+                if (token[0] != '$')
+                    continue;
+                keyword = std::string(token);
+                args.clear();
+                continue;
+            }
+            if (token != "$end")
+            {
+                args.emplace_back(token);
+                continue;
+            }
+            // Handle a complete declaration.
+            if (keyword == "$timescale")
+            {
+                std::string timescale;
+                for (const std::string& arg: args)
+                    timescale += arg;
+                if (!timescale_exp10(timescale, exp10))
+                {
+                    error = "VCD timescale \"" + timescale + "\" is invalid.";
+                    return false;
+                }
+            }
+            else if (keyword == "$scope" && args.size() >= 2)
+                scopes.push_back(args[1]);
+            else if (keyword == "$upscope" && !scopes.empty())
+                scopes.pop_back();
+            else if (keyword == "$var" && args.size() >= 4)
+            {
+                // $var <type> <width> <id> <reference> [bit select] $end
+                std::string scoped_name;
+                for (const std::string& scope: scopes)
+                    scoped_name += scope + ".";
+                scoped_name += args[3];
+                for (size_t ch = 0; ch < channel_names.size(); ++ch)
+                {
+                    if (!channel_names[ch].empty()
+                        && (channel_names[ch] == args[3]
+                            || channel_names[ch] == scoped_name))
+                        id_to_channel[args[2]] = ch;
+                }
+            }
+            else if (keyword == "$enddefinitions")
+            {
+                in_header = false;
+                break;
+            }
+            keyword.clear();
+        }
+    }
+    if (in_header)
+    {
+        error = "VCD capture has no $enddefinitions.";
+        return false;
+    }
+    for (size_t ch = 0; ch < channel_names.size(); ++ch)
+    {
+        if (channel_names[ch].empty())
+            continue;
+        bool found = false;
+        for (const auto& [id, mapped_ch]: id_to_channel)
+            found |= (mapped_ch == ch);
+        if (!found)
+        {
+            error = "VCD capture has no signal named \"" + channel_names[ch]
+                    + "\".";
+            return false;
+        }
+    }
+    // Stream value changes.
+    std::vector<int8_t> levels(channel_names.size(), -1); // -1: unknown.
+    int64_t time_ps = 0;
+    end_ps = 0;
+    bool skip_vector_id = false;
+    bool in_comment = false;
+    std::string id; // Reused to avoid allocation in the lookup.
+    while (reader.next_line(line))
+    {
+        while (next_token(line, token))
+        {
+            if (skip_vector_id) // Vector/real value changes are not used.
+            {
+                skip_vector_id = false;
+                continue;
+            }
+            if (in_comment)
+            {
+                in_comment = (token != "$end");
+                continue;
+            }
+            if (token == "$comment")
+            {
+                in_comment = true;
+                continue;
+            }
+            char c = token[0];
+            if (c == '#')
+            {
+                if (!parse_scaled_decimal(token.substr(1), exp10, time_ps))
+                {
+                    error = "VCD timestamp \"" + std::string(token)
+                            + "\" is invalid.";
+                    return false;
+                }
+                end_ps = time_ps;
+            }
+            else if (c == '0' || c == '1' || c == 'x' || c == 'X'
+                     || c == 'z' || c == 'Z')
+            {
+                id.assign(token.data() + 1, token.size() - 1);
+                auto it = id_to_channel.find(id);
+                if (it == id_to_channel.end() || (c != '0' && c != '1'))
+                    continue; // Ignore unused signals and unknown levels.
+                size_t ch = it->second;
+                int8_t level = (c == '1');
+                if (level == levels[ch])
+                    continue;
+                if (levels[ch] < 0)
+                    sink.on_initial_level(ch, time_ps, level);
+                else
+                    sink.on_edge(ch, time_ps, level);
+                levels[ch] = level;
+            }
+            else if (c == 'b' || c == 'B' || c == 'r' || c == 'R')
+                skip_vector_id = true;
+            // Ignore $dumpvars, $end, $comment, etc.
+        }
+    }
+    return true;
+}
@@ -0,0 +1,383 @@
+#include <verifier.h>
+#include <cmath>
+#include <cstdarg>
+
+namespace
+{
+
+uint32_t read_u32_le(const std::vector<UartByte>& bytes, size_t offset)
+{
+    return uint32_t(bytes[offset].value)
+           | (uint32_t(bytes[offset + 1].value) << 8)
+           | (uint32_t(bytes[offset + 2].value) << 16)
+           | (uint32_t(bytes[offset + 3].value) << 24);
+}
+
+double ps_to_us(int64_t time_ps)
+{
+    return double(time_ps) / PS_PER_US;
+}
+
+void print_stats(FILE* out, const char* label, const RunningStats& stats)
+{
+    if (stats.count() == 0)
+    {
+        fprintf(out, "  %s: n/a\n", label);
+        return;
+    }
+    fprintf(out, "  %s: mean %.3f, stddev %.3f, min %.3f, max %.3f (n=%zu)\n",
+            label, stats.mean(), stats.stddev(), stats.min(), stats.max(),
+            stats.count());
+}
+
+} // namespace
+
+Verifier::Verifier(const VerifierConfig& config)
+: config_{config},
+  clkout_decoder_{HARP_SYNC_BAUDRATE},
+  aux_decoder_{config.aux_baud_rate}
+{}
+
+void Verifier::on_initial_level(size_t channel, int64_t time_ps, bool level)
+{
+    if (time_ps < start_ps_)
+        start_ps_ = time_ps;
+    if (channel == CLKOUT)
+        clkout_decoder_.set_initial_level(level);
+    else if (channel == AUX)
+        aux_decoder_.set_initial_level(level);
+}
+
+void Verifier::on_edge(size_t channel, int64_t time_ps, bool level)
+{
+    ++edge_count_;
+    advance(time_ps);
+    if (channel == CLKOUT)
+        clkout_decoder_.on_edge(time_ps, level);
+    else if (channel == AUX)
+        aux_decoder_.on_edge(time_ps, level);
+    else if (channel == PPS)
+        handle_pps_edge(time_ps, level);
+}
+
+void Verifier::advance(int64_t time_ps)
+{
+    // Handle CLKOUT first since it defines the whole seconds that the other
+    // channels are measured against.
+    clkout_decoder_.advance(time_ps);
+    for (const UartByte& byte: clkout_decoder_.bytes())
+        handle_clkout_byte(byte);
+    clkout_decoder_.bytes().clear();
+    aux_decoder_.advance(time_ps);
+    for (const UartByte& byte: aux_decoder_.bytes())
+        handle_aux_byte(byte);
+    aux_decoder_.bytes().clear();
+}
+
+void Verifier::finish(int64_t end_ps)
+{
+    end_ps_ = end_ps;
+    if (start_ps_ == INT64_MAX)
+        start_ps_ = end_ps;
+    clkout_decoder_.finish(end_ps);
+    aux_decoder_.finish(end_ps);
+    advance(end_ps);
+}
+
+void Verifier::handle_clkout_byte(const UartByte& byte)
+{
+    int64_t byte_ps = int64_t(10 * clkout_decoder_.bit_period_ps());
+    // Bytes of one msg are sent back-to-back.
+    if (!clkout_bytes_.empty()
+        && (byte.start_ps - clkout_bytes_.back().start_ps) > (3 * byte_ps) / 2)
+    {
+        add_violation(clkout_bytes_.front().start_ps,
+                      "Incomplete CLKOUT msg.");
+        clkout_bytes_.clear();
+    }
+    if (byte.framing_error)
+    {
+        ++clkout_framing_errors_;
+        add_violation(byte.start_ps, "CLKOUT framing error.");
+        clkout_bytes_.clear();
+        return;
+    }
+    clkout_bytes_.push_back(byte);
+    // Resynchronize on the 0xAA 0xAF (standard) or 0xAA 0xAE (extended)
+    // header.
+    if (clkout_bytes_.size() == 1 && byte.value != 0xAA)
+    {
+        char what[64];
+        snprintf(what, sizeof(what), "Unexpected CLKOUT byte 0x%02X.",
+                 byte.value);
+        add_violation(byte.start_ps, what);
+        clkout_bytes_.clear();
+        return;
+    }
+    if (clkout_bytes_.size() == 2 && byte.value != 0xAF && byte.value != 0xAE)
+    {
+        add_violation(clkout_bytes_.front().start_ps,
+                      "Invalid CLKOUT msg header.");
+        clkout_bytes_.clear();
+        if (byte.value == 0xAA)
+            clkout_bytes_.push_back(byte);
+        return;
+    }
+    if (clkout_bytes_.size() == 6 && clkout_bytes_[1].value == 0xAF)
+    {
+        handle_clkout_msg();
+        clkout_bytes_.clear();
+    }
+    else if (clkout_bytes_.size() == 8) // 0xAE.
+    {
+        handle_clkout_ext_msg();
+        clkout_bytes_.clear();
+    }
+}
+
+void Verifier::handle_clkout_msg()
+{
+    ++clkout_msgs_;
+    uint32_t seconds = read_u32_le(clkout_bytes_, 2);
+    int64_t second_ps = clkout_bytes_[5].start_ps
+                        + HARP_SYNC_LAST_BYTE_TO_SECOND_PS;
+    if (!seconds_.empty())
+    {
+        const Second& prev = seconds_.back();
+        if (seconds != prev.seconds + 1)
+        {
+            char what[96];
+            snprintf(what, sizeof(what),
+                     "CLKOUT seconds jumped from %u to %u.", prev.seconds,
+                     seconds);
+            add_violation(second_ps, what);
+        }
+        else
+        {
+            double error_us = ps_to_us(second_ps - prev.time_ps - PS_PER_S);
+            clkout_period_error_us_.add(error_us);
+            if (std::fabs(error_us) > config_.period_tolerance_us)
+            {
+                char what[96];
+                snprintf(what, sizeof(what),
+                         "CLKOUT period error of %.3f us.", error_us);
+                add_violation(second_ps, what);
+            }
+        }
+    }
+    seconds_.push_back({seconds, second_ps});
+    if (seconds_.size() > 8)
+        seconds_.pop_front();
+}
+
+void Verifier::handle_clkout_ext_msg()
+{
+    ++clkout_ext_msgs_;
+    uint32_t seconds = read_u32_le(clkout_bytes_, 2);
+    uint16_t ticks = uint16_t(clkout_bytes_[6].value)
+                     | (uint16_t(clkout_bytes_[7].value) << 8);
+    const Second* second = find_second(seconds);
+    if (second == nullptr)
+    {
+        ++clkout_ext_unreferenced_;
+        return;
+    }
+    // The encoded time is truncated to the tick, so the msg starts up to one
+    // tick after it.
+    int64_t encoded_ps = second->time_ps + ticks * HARP_CLKOUT_EXT_TICK_PS;
+    double offset_us = ps_to_us(clkout_bytes_.front().start_ps - encoded_ps);
+    clkout_ext_offset_us_.add(offset_us);
+    if (offset_us < -config_.ext_limit_us
+        || offset_us > ps_to_us(HARP_CLKOUT_EXT_TICK_PS) + config_.ext_limit_us)
+    {
+        char what[96];
+        snprintf(what, sizeof(what),
+                 "Extended CLKOUT msg starts %.3f us from its encoded time.",
+                 offset_us);
+        add_violation(clkout_bytes_.front().start_ps, what);
+    }
+}
+
+void Verifier::handle_aux_byte(const UartByte& byte)
+{
+    int64_t byte_ps = int64_t(10 * aux_decoder_.bit_period_ps());
+    if (!aux_bytes_.empty()
+        && (byte.start_ps - aux_bytes_.back().start_ps) > (3 * byte_ps) / 2)
+    {
+        add_violation(aux_bytes_.front().start_ps, "Incomplete AUX msg.");
+        aux_bytes_.clear();
+    }
+    if (byte.framing_error)
+    {
+        ++aux_framing_errors_;
+        add_violation(byte.start_ps, "AUX framing error.");
+        aux_bytes_.clear();
+        return;
+    }
+    aux_bytes_.push_back(byte);
+    if (aux_bytes_.size() == 4)
+    {
+        handle_aux_msg();
+        aux_bytes_.clear();
+    }
+}
+
+void Verifier::handle_aux_msg()
+{
+    uint32_t seconds = read_u32_le(aux_bytes_, 0);
+    int64_t start_ps = aux_bytes_.front().start_ps;
+    if (aux_msgs_ > 0)
+        aux_period_error_us_.add(ps_to_us(start_ps - last_aux_msg_ps_ - PS_PER_S));
+    ++aux_msgs_;
+    last_aux_msg_ps_ = start_ps;
+    if (!config_.has_clkout)
+        return;
+    const Second* second = nearest_second(start_ps);
+    if (second == nullptr)
+    {
+        ++aux_unreferenced_;
+        return;
+    }
+    double offset_us = ps_to_us(start_ps - second->time_ps);
+    aux_offset_us_.add(offset_us);
+    if (seconds != second->seconds)
+    {
+        char what[96];
+        snprintf(what, sizeof(what),
+                 "AUX msg encodes second %u but starts on second %u.",
+                 seconds, second->seconds);
+        add_violation(start_ps, what);
+    }
+    if (std::fabs(offset_us) > config_.aux_limit_us)
+    {
+        char what[96];
+        snprintf(what, sizeof(what),
+                 "AUX msg starts %.3f us from the whole second.", offset_us);
+        add_violation(start_ps, what);
+    }
+}
+
+void Verifier::handle_pps_edge(int64_t time_ps, bool level)
+{
+    if (!level) // Falling edge on the half second.
+    {
+        if (has_pps_rise_)
+            pps_high_time_error_us_.add(
+                ps_to_us(time_ps - last_pps_rise_ps_ - PS_PER_S / 2));
+        return;
+    }
+    // Rising edge on the whole second.
+    if (has_pps_rise_)
+        pps_period_error_us_.add(
+            ps_to_us(time_ps - last_pps_rise_ps_ - PS_PER_S));
+    ++pps_pulses_;
+    has_pps_rise_ = true;
+    last_pps_rise_ps_ = time_ps;
+    if (!config_.has_clkout)
+        return;
+    const Second* second = nearest_second(time_ps);
+    if (second == nullptr)
+    {
+        ++pps_unreferenced_;
+        return;
+    }
+    double offset_us = ps_to_us(time_ps - second->time_ps);
+    pps_offset_us_.add(offset_us);
+    if (std::fabs(offset_us) > config_.pps_limit_us)
+    {
+        char what[96];
+        snprintf(what, sizeof(what),
+                 "PPS rises %.3f us from the whole second.", offset_us);
+        add_violation(time_ps, what);
+    }
+}
+
+const Verifier::Second* Verifier::nearest_second(int64_t time_ps) const
+{
+    const Second* nearest = nullptr;
+    int64_t nearest_distance_ps = PS_PER_S / 2;
+    for (const Second& second: seconds_)
+    {
+        int64_t distance_ps = std::llabs(time_ps - second.time_ps);
+        if (distance_ps < nearest_distance_ps)
+        {
+            nearest = &second;
+            nearest_distance_ps = distance_ps;
+        }
+    }
+    return nearest;
+}
+
+const Verifier::Second* Verifier::find_second(uint32_t seconds) const
+{
+    for (const Second& second: seconds_)
+    {
+        if (second.seconds == seconds)
+            return &second;
+    }
+    return nullptr;
+}
+
+void Verifier::add_violation(int64_t time_ps, const std::string& what)
+{
+    ++violation_count_;
+    if (violations_.size() >= config_.max_listed_violations)
+        return;
+    char when[32];
+    snprintf(when, sizeof(when), "[%.6f s] ", double(time_ps) / PS_PER_S);
+    violations_.push_back(when + what);
+}
+
+void Verifier::print_report(FILE* out) const
+{
+    fprintf(out, "Capture: %.6f s, %zu edges.\n",
+            double(end_ps_ - start_ps_) / PS_PER_S, edge_count_);
+    if (config_.has_clkout)
+    {
+        fprintf(out, "CLKOUT (%u bps):\n", HARP_SYNC_BAUDRATE);
+        fprintf(out, "  msgs: %zu, extended msgs: %zu, framing errors: %zu\n",
+                clkout_msgs_, clkout_ext_msgs_, clkout_framing_errors_);
+        if (!seconds_.empty())
+            fprintf(out, "  last second: %u\n", seconds_.back().seconds);
+        print_stats(out, "period error [us]", clkout_period_error_us_);
+        if (clkout_ext_msgs_ > 0)
+        {
+            print_stats(out, "extended msg offset from encoded time [us]",
+                        clkout_ext_offset_us_);
+            fprintf(out, "  extended msgs without a reference second: %zu\n",
+                    clkout_ext_unreferenced_);
+        }
+    }
+    if (config_.has_aux)
+    {
+        fprintf(out, "AUX UART (%u bps):\n", config_.aux_baud_rate);
+        fprintf(out, "  msgs: %zu, framing errors: %zu\n", aux_msgs_,
+                aux_framing_errors_);
+        if (config_.has_clkout)
+        {
+            print_stats(out, "offset from whole second [us]", aux_offset_us_);
+            fprintf(out, "  msgs without a reference second: %zu\n",
+                    aux_unreferenced_);
+        }
+        print_stats(out, "period error [us]", aux_period_error_us_);
+    }
+    if (config_.has_pps)
+    {
+        fprintf(out, "PPS:\n");
+        fprintf(out, "  pulses: %zu\n", pps_pulses_);
+        if (config_.has_clkout)
+        {
+            print_stats(out, "offset from whole second [us]", pps_offset_us_);
+            fprintf(out, "  pulses without a reference second: %zu\n",
+                    pps_unreferenced_);
+        }
+        print_stats(out, "period error [us]", pps_period_error_us_);
+        print_stats(out, "high time error [us]", pps_high_time_error_us_);
+    }
+    fprintf(out, "Violations: %zu\n", violation_count_);
+    for (const std::string& violation: violations_)
+        fprintf(out, "  %s\n", violation.c_str());
+    if (violation_count_ > violations_.size())
+        fprintf(out, "  ... and %zu more.\n",
+                violation_count_ - violations_.size());
+}